@@ -0,0 +1,240 @@
+#include "cobs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// Default data size if the last level cache size is unknown.
+#define BENCH_DEFAULT_SIZE (256 * 1024 * 1024)
+
+/// Bytes of input added between passes over the working set.
+#define BENCH_SLICE (1024 * 1024)
+
+/// Number of timed repetitions; the best is reported.
+#define BENCH_REPEAT 3
+
+/// Buffers shared by all measurements.
+struct bench
+{
+    /// Plain data.
+    uint8_t *plain;
+    /// Length of plain data.
+    size_t length;
+    /// Encoded data.
+    uint8_t *encoded;
+    /// Length of encoded data.
+    size_t encoded_length;
+    /// Capacity of encoded data.
+    size_t capacity;
+    /// Output buffer.
+    uint8_t *output;
+    /// Working set of the co-running workload.
+    volatile uint64_t *working_set;
+    /// Number of words in the working set.
+    size_t words;
+};
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+/// Read and modify every cache line of the working set.
+/// @return Elapsed time in seconds.
+static double touch_working_set(struct bench *b)
+{
+    double start = now();
+    size_t i;
+
+    for (i = 0; i < b->words; i += 8) {
+        b->working_set[i]++;
+    }
+
+    return now() - start;
+}
+
+/// Encode or decode all data in one call.
+/// @return Elapsed time in seconds.
+static double run_one_shot(struct bench *b, bool decode, bool nontemporal)
+{
+    double start = now();
+    ssize_t r;
+
+    if (decode) {
+        r = nontemporal ? cobs_decode_nontemporal(b->encoded, b->encoded_length, b->output, b->length, true)
+                        : cobs_decode(b->encoded, b->encoded_length, b->output, b->length, true);
+    } else {
+        r = nontemporal ? cobs_encode_nontemporal(b->plain, b->length, b->output, b->capacity)
+                        : cobs_encode(b->plain, b->length, b->output, b->capacity);
+    }
+
+    if (r < 0) {
+        fprintf(stderr, "bench: %s failed: %zd\n", decode ? "decode" : "encode", r);
+        exit(EXIT_FAILURE);
+    }
+
+    return now() - start;
+}
+
+/// Encode or decode a slice at a time, passing over the working set after each slice.
+/// @return Mean time in seconds of a pass over the working set.
+static double run_interleaved(struct bench *b, bool decode, bool nontemporal)
+{
+    struct cobs_encode_state *e = cobs_encode_new();
+    struct cobs_decode_state *d = cobs_decode_new();
+    const uint8_t *input = decode ? b->encoded : b->plain;
+    size_t length = decode ? b->encoded_length : b->length;
+    double elapsed = 0;
+    size_t passes = 0;
+    size_t i;
+    size_t n;
+
+    cobs_encode_set_nontemporal(e, nontemporal);
+    cobs_decode_set_nontemporal(d, nontemporal);
+
+    if (decode) {
+        cobs_decode_start(d, b->output, b->length);
+    } else {
+        cobs_encode_start(e, b->output, b->capacity);
+    }
+
+    touch_working_set(b);
+
+    for (i = 0; i < length; i += n) {
+        n = length - i < BENCH_SLICE ? length - i : BENCH_SLICE;
+
+        if ((decode ? cobs_decode_add(d, input + i, n) : cobs_encode_add(e, input + i, n)) < 0) {
+            fprintf(stderr, "bench: add failed\n");
+            exit(EXIT_FAILURE);
+        }
+
+        elapsed += touch_working_set(b);
+        passes++;
+    }
+
+    if (decode) {
+        cobs_decode_finish(d, true);
+    } else {
+        cobs_encode_finish(e);
+    }
+
+    cobs_decode_delete(d);
+    cobs_encode_delete(e);
+    return elapsed / (double)passes;
+}
+
+static void report(struct bench *b, bool decode)
+{
+    const char *name = decode ? "decode" : "encode";
+    double best[2] = { 1e9, 1e9 };
+    double pass[2] = { 1e9, 1e9 };
+    double t;
+    int nontemporal;
+    int i;
+
+    for (i = 0; i < BENCH_REPEAT; ++i) {
+        for (nontemporal = 0; nontemporal < 2; ++nontemporal) {
+            t = run_one_shot(b, decode, nontemporal);
+            if (t < best[nontemporal]) {
+                best[nontemporal] = t;
+            }
+
+            t = run_interleaved(b, decode, nontemporal);
+            if (t < pass[nontemporal]) {
+                pass[nontemporal] = t;
+            }
+        }
+    }
+
+    for (nontemporal = 0; nontemporal < 2; ++nontemporal) {
+        printf("%s %-12s %8.1f MB/s   working set pass %8.1f us\n",
+               name, nontemporal ? "nontemporal" : "cached",
+               (double)b->length / best[nontemporal] / 1e6, pass[nontemporal] * 1e6);
+    }
+}
+
+/// usage: bench_cobs [DATA_MIB [WORKING_SET_KIB]]
+/// Data defaults to twice the last level cache, the working set to half the second level cache.
+int main(int argc, char *argv[])
+{
+    struct bench b;
+    size_t working_set = 1024 * 1024;
+    long cache;
+    double idle = 1e9;
+    double t;
+    size_t i;
+    ssize_t r;
+
+    b.length = BENCH_DEFAULT_SIZE;
+
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    cache = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (cache > 0) {
+        b.length = 2 * (size_t)cache;
+    }
+#endif
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    cache = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (cache > 0) {
+        working_set = (size_t)cache / 2;
+    }
+#endif
+
+    if (argc > 1) {
+        b.length = (size_t)strtoul(argv[1], NULL, 10) * 1024 * 1024;
+    }
+    if (argc > 2) {
+        working_set = (size_t)strtoul(argv[2], NULL, 10) * 1024;
+    }
+
+    b.capacity = cobs_maximum_sizeof(b.length);
+    b.plain = malloc(b.length);
+    b.encoded = malloc(b.capacity);
+    b.output = malloc(b.capacity);
+    b.words = working_set / sizeof(uint64_t);
+    b.working_set = calloc(b.words, sizeof(uint64_t));
+
+    if (!b.plain || !b.encoded || !b.output || !b.working_set) {
+        fprintf(stderr, "bench: out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    srand(1);
+    for (i = 0; i < b.length; ++i) {
+        // Mostly long runs, as in image data.
+        b.plain[i] = (rand() % 256) ? (uint8_t)(rand() | 1) : 0x00;
+    }
+
+    r = cobs_encode(b.plain, b.length, b.encoded, b.capacity);
+    if (r < 0) {
+        fprintf(stderr, "bench: encode failed: %zd\n", r);
+        return EXIT_FAILURE;
+    }
+    b.encoded_length = (size_t)r;
+
+    // Touch the output so that page faults are not measured.
+    memset(b.output, 0, b.capacity);
+
+    for (i = 0; i < 16; ++i) {
+        t = touch_working_set(&b);
+        if (t < idle) {
+            idle = t;
+        }
+    }
+
+    printf("data %zu MiB, working set %zu KiB\n", b.length >> 20, working_set >> 10);
+    printf("idle                                    working set pass %8.1f us\n", idle * 1e6);
+
+    report(&b, false);
+    report(&b, true);
+
+    free((void *)b.working_set);
+    free(b.output);
+    free(b.encoded);
+    free(b.plain);
+    return EXIT_SUCCESS;
+}
@@ -5,12 +5,37 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /// Maximum offset value.
 #define COBS_OFFSET_MAX 255
 
 /// Maximum run length of non-NUL bytes.
 #define COBS_MAX_RUN_LENGTH (COBS_OFFSET_MAX - 1)
 
+/// Cache line size, the unit of non-temporal output.
+#define COBS_LINE_SIZE 64
+
+/// Encoder staging size.
+/// Holds the line with the pending offset byte, at most COBS_OFFSET_MAX bytes
+/// behind the current position, and every line after it.
+#define COBS_STAGE_SIZE (8 * COBS_LINE_SIZE)
+
+/// Distance ahead of the current input position to prefetch.
+#define COBS_PREFETCH_DISTANCE (8 * COBS_LINE_SIZE)
+
+#if defined(__GNUC__)
+/// Prefetch @c addr for reading, without temporal locality.
+#define COBS_PREFETCH(addr) __builtin_prefetch((addr), 0, 0)
+#else
+#define COBS_PREFETCH(addr) ((void)(addr))
+#endif
+
+/// NUL bytes referenced by decoded segments.
+static const uint8_t cobs_nul[COBS_OFFSET_MAX];
+
 struct cobs_encode_state
 {
     /// Pointer to output buffer.
@@ -23,6 +48,13 @@ struct cobs_encode_state
     uint8_t *offset_storage;
     /// Offset to next NUL byte.
     uint8_t offset;
+    /// Write output with non-temporal stores.
+    bool nontemporal;
+    /// First staged output cache line, or NULL.
+    uint8_t *line;
+    /// Staged bytes, indexed by output address modulo COBS_STAGE_SIZE,
+    /// followed by a line which takes writes past the end.
+    uint8_t stage[COBS_STAGE_SIZE + COBS_LINE_SIZE];
 };
 
 struct cobs_decode_state
@@ -37,8 +69,36 @@ struct cobs_decode_state
     uint8_t offset;
     /// Number of non-NUL bytes to emit.
     uint8_t run;
+    /// Write output with non-temporal stores.
+    bool nontemporal;
+    /// Output cache line being staged, or NULL.
+    uint8_t *line;
+    /// Staged bytes of @c line.
+    uint8_t stage[COBS_LINE_SIZE];
 };
 
+/// Write the cache line at @c line from @c stage, bypassing the cache.
+static void cobs_stream_line(uint8_t *line, const uint8_t *stage)
+{
+#if defined(__SSE2__)
+    size_t i;
+
+    for (i = 0; i < COBS_LINE_SIZE; i += sizeof(__m128i)) {
+        _mm_stream_si128((__m128i *)(line + i), _mm_loadu_si128((const __m128i *)(stage + i)));
+    }
+#else
+    memcpy(line, stage, COBS_LINE_SIZE);
+#endif
+}
+
+/// Order non-temporal stores before subsequent stores.
+static void cobs_stream_fence(void)
+{
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
+}
+
 /// Fixed overhead of one, for the initial byte.
 /// Additional overhead of one byte for every COBS_MAX_RUN_LENGTH non-NUL bytes.
 size_t cobs_maximum_sizeof(size_t length)
@@ -90,6 +150,33 @@ int cobs_encode_clear(struct cobs_encode_state *s)
 /// | offset | data   | offset | data   | ...
 /// +--------+---//---+--------+---//---+---
 /// ```
+/// Staged copy of output byte @c p.
+static uint8_t *cobs_encode_stage(struct cobs_encode_state *s, const uint8_t *p)
+{
+    return s->stage + ((uintptr_t)p & (COBS_STAGE_SIZE - 1));
+}
+
+/// Write any staged bytes to output, and order non-temporal stores before
+/// subsequent stores.
+static void cobs_encode_flush(struct cobs_encode_state *s)
+{
+    uint8_t *line;
+    size_t n;
+
+    if (s->line) {
+        for (line = s->line; line < s->encoded; line += COBS_LINE_SIZE) {
+            n = (size_t)(s->encoded - line);
+            memcpy(line, cobs_encode_stage(s, line), n < COBS_LINE_SIZE ? n : COBS_LINE_SIZE);
+        }
+
+        s->line = NULL;
+    }
+
+    if (s->nontemporal) {
+        cobs_stream_fence();
+    }
+}
+
 int cobs_encode_start(struct cobs_encode_state *s, uint8_t *output, size_t capacity)
 {
     if (!s || !output) {
@@ -100,6 +187,9 @@ int cobs_encode_start(struct cobs_encode_state *s, uint8_t *output, size_t capac
         return -ENOSPC;
     }
 
+    // Complete any abandoned frame.
+    cobs_encode_flush(s);
+
     s->output = output;
     s->capacity = capacity;
 
@@ -111,16 +201,20 @@ int cobs_encode_start(struct cobs_encode_state *s, uint8_t *output, size_t capac
     return 0;
 }
 
-int cobs_encode_add(struct cobs_encode_state *s, const uint8_t *data, size_t length)
+/// Encode @c length bytes of @c data.
+/// Each byte is either encoded completely or not at all, so on error the state
+/// remains consistent and @c consumed tells where encoding stopped.
+/// @return Zero on success, negative errno otherwise.
+static int cobs_encode_bytes(struct cobs_encode_state *s, const uint8_t *data, size_t length, size_t *consumed)
 {
-    if (!s || !data) {
-        return -EFAULT;
-    }
+    const uint8_t *start = data;
+    int r = 0;
 
     while (length) {
         if (*data) {
             if (!s->capacity) {
-                return -ENOSPC;
+                r = -ENOSPC;
+                break;
             }
 
             *s->encoded++ = *data;
@@ -134,7 +228,15 @@ int cobs_encode_add(struct cobs_encode_state *s, const uint8_t *data, size_t len
             *s->offset_storage = s->offset;
 
             if (!s->capacity) {
-                return -ENOSPC;
+                if (*data) {
+                    // Undo the partially encoded byte.
+                    s->encoded--;
+                    s->capacity++;
+                    s->offset--;
+                }
+
+                r = -ENOSPC;
+                break;
             }
 
             s->offset_storage = s->encoded++;
@@ -147,6 +249,152 @@ int cobs_encode_add(struct cobs_encode_state *s, const uint8_t *data, size_t len
         length--;
     }
 
+    *consumed = (size_t)(data - start);
+    return r;
+}
+
+/// Encode @c length bytes of @c data, staging output so that each complete cache
+/// line is written with non-temporal stores once it no longer holds the pending
+/// offset byte.  Bytes before the first line boundary are written directly.
+/// @see cobs_encode_bytes
+static int cobs_encode_stream(struct cobs_encode_state *s, const uint8_t *data, size_t length, size_t *consumed)
+{
+    uint8_t *encoded;
+    uint8_t *offset_storage;
+    uint8_t *staged;
+    uint8_t *staged_offset_storage;
+    size_t capacity;
+    size_t room;
+    size_t done;
+    size_t n;
+    int r;
+
+    *consumed = 0;
+
+    while (length) {
+        encoded = s->encoded;
+        offset_storage = s->offset_storage;
+        capacity = s->capacity;
+        room = COBS_LINE_SIZE - ((uintptr_t)encoded & (COBS_LINE_SIZE - 1));
+
+        if (length > COBS_PREFETCH_DISTANCE) {
+            COBS_PREFETCH(data + COBS_PREFETCH_DISTANCE);
+        }
+
+        if (!s->line && room == COBS_LINE_SIZE) {
+            // Start staging at a line boundary.
+            s->line = encoded;
+        }
+
+        // A byte may need two bytes of output, so also take the next line,
+        // or a single byte of it when writing the head directly.
+        room += s->line ? COBS_LINE_SIZE : 1;
+
+        if (s->line) {
+            s->encoded = cobs_encode_stage(s, encoded);
+            if (offset_storage >= s->line) {
+                s->offset_storage = cobs_encode_stage(s, offset_storage);
+            }
+        }
+
+        staged = s->encoded;
+        staged_offset_storage = s->offset_storage;
+
+        n = capacity < room ? capacity : room;
+        s->capacity = n;
+
+        r = cobs_encode_bytes(s, data, length, &done);
+
+        if (s->line && s->encoded > s->stage + COBS_STAGE_SIZE) {
+            // Wrap bytes written past the end.
+            memcpy(s->stage, s->stage + COBS_STAGE_SIZE, (size_t)(s->encoded - (s->stage + COBS_STAGE_SIZE)));
+        }
+
+        if (s->offset_storage == staged_offset_storage) {
+            s->offset_storage = offset_storage;
+        } else {
+            // New offset storage, at or after the initial position.
+            s->offset_storage = encoded + (s->offset_storage - staged);
+        }
+
+        n -= s->capacity;
+        s->encoded = encoded + n;
+        s->capacity = capacity - n;
+
+        if (!s->line && n == room) {
+            // Stage the byte written past the head.
+            s->line = s->encoded - 1;
+            *cobs_encode_stage(s, s->line) = *s->line;
+        }
+
+        *consumed += done;
+        data += done;
+        length -= done;
+
+        // Stream complete lines, up to the line holding the pending offset byte.
+        while (s->line && s->line + COBS_LINE_SIZE <= s->encoded &&
+               (s->offset_storage < s->line || s->offset_storage >= s->line + COBS_LINE_SIZE)) {
+            cobs_stream_line(s->line, cobs_encode_stage(s, s->line));
+            s->line += COBS_LINE_SIZE;
+        }
+
+        // Reaching the end of the line is not an error.
+        if (r < 0 && (r != -ENOSPC || capacity <= room)) {
+            return r;
+        }
+    }
+
+    return 0;
+}
+
+/// Encode @c length bytes of @c data.
+/// @see cobs_encode_bytes
+static int cobs_encode_run(struct cobs_encode_state *s, const uint8_t *data, size_t length, size_t *consumed)
+{
+    if (s->nontemporal) {
+        return cobs_encode_stream(s, data, length, consumed);
+    }
+
+    return cobs_encode_bytes(s, data, length, consumed);
+}
+
+int cobs_encode_add(struct cobs_encode_state *s, const uint8_t *data, size_t length)
+{
+    size_t consumed;
+
+    if (!s || !data) {
+        return -EFAULT;
+    }
+
+    return cobs_encode_run(s, data, length, &consumed);
+}
+
+int cobs_encode_add_partial(struct cobs_encode_state *s, const uint8_t *data, size_t length, size_t *consumed, size_t *produced)
+{
+    uint8_t *encoded;
+    int r;
+
+    if (!s || !data || !consumed || !produced) {
+        return -EFAULT;
+    }
+
+    encoded = s->encoded;
+
+    r = cobs_encode_run(s, data, length, consumed);
+
+    *produced = (size_t)(s->encoded - encoded);
+    return r;
+}
+
+int cobs_encode_set_nontemporal(struct cobs_encode_state *s, bool enable)
+{
+    if (!s) {
+        return -EFAULT;
+    }
+
+    cobs_encode_flush(s);
+
+    s->nontemporal = enable;
     return 0;
 }
 
@@ -156,6 +404,8 @@ ssize_t cobs_encode_finish(struct cobs_encode_state *s)
         return -EFAULT;
     }
 
+    cobs_encode_flush(s);
+
     *s->offset_storage = s->offset;
 
     return (ssize_t)(s->encoded - s->output);
@@ -166,7 +416,9 @@ void cobs_encode_delete(struct cobs_encode_state *s)
     free(s);
 }
 
-ssize_t cobs_encode(const uint8_t *data, size_t length, uint8_t *output, size_t capacity)
+/// Encode @c data in one call.
+/// @see cobs_encode
+static ssize_t cobs_encode_frame(const uint8_t *data, size_t length, uint8_t *output, size_t capacity, bool nontemporal)
 {
     struct cobs_encode_state s;
     int r;
@@ -176,22 +428,32 @@ ssize_t cobs_encode(const uint8_t *data, size_t length, uint8_t *output, size_t
     }
 
     cobs_encode_clear(&s);
+    s.nontemporal = nontemporal;
 
     r = cobs_encode_start(&s, output, capacity);
     if (r < 0) {
         return r;
     }
 
-    while (length--) {
-        r = cobs_encode_add(&s, data++, 1);
-        if (r < 0) {
-            return r;
-        }
+    r = cobs_encode_add(&s, data, length);
+    if (r < 0) {
+        cobs_encode_flush(&s);
+        return r;
     }
 
     return cobs_encode_finish(&s);
 }
 
+ssize_t cobs_encode(const uint8_t *data, size_t length, uint8_t *output, size_t capacity)
+{
+    return cobs_encode_frame(data, length, output, capacity, false);
+}
+
+ssize_t cobs_encode_nontemporal(const uint8_t *data, size_t length, uint8_t *output, size_t capacity)
+{
+    return cobs_encode_frame(data, length, output, capacity, true);
+}
+
 struct cobs_decode_state *cobs_decode_new(void)
 {
     struct cobs_decode_state *s = calloc(1, sizeof(struct cobs_decode_state));
@@ -208,6 +470,20 @@ int cobs_decode_clear(struct cobs_decode_state *s)
     return 0;
 }
 
+/// Write any partially staged cache line to output, and order non-temporal stores
+/// before subsequent stores.
+static void cobs_decode_flush(struct cobs_decode_state *s)
+{
+    if (s->line) {
+        memcpy(s->line, s->stage, (size_t)(s->decoded - s->line));
+        s->line = NULL;
+    }
+
+    if (s->nontemporal) {
+        cobs_stream_fence();
+    }
+}
+
 int cobs_decode_start(struct cobs_decode_state *s, uint8_t *output, size_t capacity)
 {
     if (!s || !output) {
@@ -218,6 +494,9 @@ int cobs_decode_start(struct cobs_decode_state *s, uint8_t *output, size_t capac
         return -ENOSPC;
     }
 
+    // Complete any abandoned frame.
+    cobs_decode_flush(s);
+
     s->output = output;
 
     s->decoded = output;
@@ -228,22 +507,27 @@ int cobs_decode_start(struct cobs_decode_state *s, uint8_t *output, size_t capac
     return 0;
 }
 
-int cobs_decode_add(struct cobs_decode_state *s, const uint8_t *data, size_t length)
+/// Decode @c length bytes of @c data.
+/// Each byte is either decoded completely or not at all, so on error the state
+/// remains consistent and @c consumed tells where decoding stopped.
+/// @return Zero on success, negative errno otherwise.
+static int cobs_decode_bytes(struct cobs_decode_state *s, const uint8_t *data, size_t length, size_t *consumed)
 {
-    if (!s || !data) {
-        return -EFAULT;
-    }
+    const uint8_t *start = data;
+    int r = 0;
 
     while (length) {
         if (!*data) {
             // Delimiter found.
-            return -EILSEQ;
+            r = -EILSEQ;
+            break;
         }
 
         if (s->run) {
             // Run of data which does not contain 0x00.
             if (!s->capacity) {
-                return -ENOSPC;
+                r = -ENOSPC;
+                break;
             }
 
             *s->decoded++ = *data;
@@ -253,7 +537,8 @@ int cobs_decode_add(struct cobs_decode_state *s, const uint8_t *data, size_t len
         } else {
             if (s->offset != COBS_OFFSET_MAX) {
                 if (!s->capacity) {
-                    return -ENOSPC;
+                    r = -ENOSPC;
+                    break;
                 }
 
                 *s->decoded++ = 0x00;
@@ -268,6 +553,138 @@ int cobs_decode_add(struct cobs_decode_state *s, const uint8_t *data, size_t len
         length--;
     }
 
+    *consumed = (size_t)(data - start);
+    return r;
+}
+
+/// Decode @c length bytes of @c data, staging output a cache line at a time so
+/// that each complete line is written with non-temporal stores.
+/// Bytes before the first line boundary are written directly.
+/// @see cobs_decode_bytes
+static int cobs_decode_stream(struct cobs_decode_state *s, const uint8_t *data, size_t length, size_t *consumed)
+{
+    uint8_t *decoded;
+    size_t capacity;
+    size_t room;
+    size_t done;
+    size_t n;
+    int r;
+
+    *consumed = 0;
+
+    while (length) {
+        decoded = s->decoded;
+        capacity = s->capacity;
+        room = COBS_LINE_SIZE - ((uintptr_t)decoded & (COBS_LINE_SIZE - 1));
+
+        if (length > COBS_PREFETCH_DISTANCE) {
+            COBS_PREFETCH(data + COBS_PREFETCH_DISTANCE);
+        }
+
+        if (!s->line && room == COBS_LINE_SIZE) {
+            // Start staging at a line boundary.
+            s->line = decoded;
+        }
+
+        if (s->line) {
+            s->decoded = s->stage + (decoded - s->line);
+        }
+
+        // Decode up to the end of the line.
+        n = capacity < room ? capacity : room;
+        s->capacity = n;
+
+        r = cobs_decode_bytes(s, data, length, &done);
+
+        n -= s->capacity;
+        s->decoded = decoded + n;
+        s->capacity = capacity - n;
+
+        *consumed += done;
+        data += done;
+        length -= done;
+
+        if (s->line && s->decoded == s->line + COBS_LINE_SIZE) {
+            cobs_stream_line(s->line, s->stage);
+            s->line = NULL;
+        }
+
+        // Reaching the end of the line is not an error.
+        if (r < 0 && (r != -ENOSPC || capacity <= room)) {
+            return r;
+        }
+    }
+
+    return 0;
+}
+
+/// Decode @c length bytes of @c data.
+/// @see cobs_decode_bytes
+static int cobs_decode_run(struct cobs_decode_state *s, const uint8_t *data, size_t length, size_t *consumed)
+{
+    if (s->nontemporal) {
+        return cobs_decode_stream(s, data, length, consumed);
+    }
+
+    return cobs_decode_bytes(s, data, length, consumed);
+}
+
+int cobs_decode_add(struct cobs_decode_state *s, const uint8_t *data, size_t length)
+{
+    size_t consumed;
+
+    if (!s || !data) {
+        return -EFAULT;
+    }
+
+    return cobs_decode_run(s, data, length, &consumed);
+}
+
+int cobs_decode_add_partial(struct cobs_decode_state *s, const uint8_t *data, size_t length, size_t *consumed, size_t *produced)
+{
+    uint8_t *decoded;
+    int r;
+
+    if (!s || !data || !consumed || !produced) {
+        return -EFAULT;
+    }
+
+    decoded = s->decoded;
+
+    r = cobs_decode_run(s, data, length, consumed);
+
+    *produced = (size_t)(s->decoded - decoded);
+    return r;
+}
+
+int cobs_decode_set_nontemporal(struct cobs_decode_state *s, bool enable)
+{
+    if (!s) {
+        return -EFAULT;
+    }
+
+    cobs_decode_flush(s);
+
+    s->nontemporal = enable;
+    return 0;
+}
+
+int cobs_decode_resume(struct cobs_decode_state *s, uint8_t *output, size_t capacity)
+{
+    if (!s || !output) {
+        return -EFAULT;
+    }
+
+    if (capacity < 1) {
+        return -ENOSPC;
+    }
+
+    cobs_decode_flush(s);
+
+    s->output = output;
+
+    s->decoded = output;
+    s->capacity = capacity;
     return 0;
 }
 
@@ -277,11 +694,18 @@ ssize_t cobs_decode_finish(struct cobs_decode_state *s, bool strict)
         return -EFAULT;
     }
 
+    cobs_decode_flush(s);
+
     // In strict mode, the final run of non-NUL data bytes must complete.
     if (strict && s->run) {
         return -EMSGSIZE;
     }
 
+    if (!s->output) {
+        // Zero-copy decoding writes no output.
+        return 0;
+    }
+
     return (ssize_t)(s->decoded - s->output);
 }
 
@@ -290,7 +714,9 @@ void cobs_decode_delete(struct cobs_decode_state *s)
     free(s);
 }
 
-ssize_t cobs_decode(const uint8_t *data, size_t length, uint8_t *output, size_t capacity, bool strict)
+/// Decode @c data in one call.
+/// @see cobs_decode
+static ssize_t cobs_decode_frame(const uint8_t *data, size_t length, uint8_t *output, size_t capacity, bool strict, bool nontemporal)
 {
     struct cobs_decode_state s;
     int r;
@@ -300,18 +726,152 @@ ssize_t cobs_decode(const uint8_t *data, size_t length, uint8_t *output, size_t
     }
 
     cobs_decode_clear(&s);
+    s.nontemporal = nontemporal;
 
     r = cobs_decode_start(&s, output, capacity);
     if (r < 0) {
         return r;
     }
 
-    while (length--) {
-        r = cobs_decode_add(&s, data++, 1);
+    r = cobs_decode_add(&s, data, length);
+    if (r < 0) {
+        cobs_decode_flush(&s);
+        return r;
+    }
+
+    return cobs_decode_finish(&s, strict);
+}
+
+ssize_t cobs_decode(const uint8_t *data, size_t length, uint8_t *output, size_t capacity, bool strict)
+{
+    return cobs_decode_frame(data, length, output, capacity, strict, false);
+}
+
+ssize_t cobs_decode_nontemporal(const uint8_t *data, size_t length, uint8_t *output, size_t capacity, bool strict)
+{
+    return cobs_decode_frame(data, length, output, capacity, strict, true);
+}
+
+/// Append a segment of @c length bytes at @c base.
+/// Adjacent NUL segments are merged, up to the size of @c cobs_nul.
+/// @return Zero on success, negative errno otherwise.
+static int cobs_iov_add(struct iovec *iov, size_t iovcnt, size_t *count, const uint8_t *base, size_t length)
+{
+    if (base == cobs_nul && *count && iov[*count - 1].iov_base == (void *)cobs_nul && iov[*count - 1].iov_len < sizeof(cobs_nul)) {
+        iov[*count - 1].iov_len++;
+        return 0;
+    }
+
+    if (*count == iovcnt) {
+        return -ENOSPC;
+    }
+
+    iov[*count].iov_base = (void *)base;
+    iov[*count].iov_len = length;
+    (*count)++;
+    return 0;
+}
+
+int cobs_decode_start_iov(struct cobs_decode_state *s)
+{
+    if (!s) {
+        return -EFAULT;
+    }
+
+    cobs_decode_flush(s);
+
+    s->output = NULL;
+
+    s->decoded = NULL;
+    s->capacity = 0;
+
+    s->offset = COBS_OFFSET_MAX;
+    s->run = 0;
+    return 0;
+}
+
+/// Follows the same offset/run structure as cobs_decode_add(), but emits each
+/// run of non-NUL bytes as one segment instead of copying it byte by byte.
+/// Works on copies of @c offset and @c run, so that the state is unchanged on error.
+ssize_t cobs_decode_add_iov(struct cobs_decode_state *s, const uint8_t *data, size_t length, struct iovec *iov, size_t iovcnt)
+{
+    const uint8_t *end;
+    size_t count = 0;
+    uint8_t offset;
+    uint8_t run;
+    size_t n;
+    int r;
+
+    if (!s || !data || !iov) {
+        return -EFAULT;
+    }
+
+    offset = s->offset;
+    run = s->run;
+
+    end = data + length;
+
+    while (data != end) {
+        if (!run) {
+            if (!*data) {
+                // Delimiter found.
+                return -EILSEQ;
+            }
+
+            if (offset != COBS_OFFSET_MAX) {
+                r = cobs_iov_add(iov, iovcnt, &count, cobs_nul, 1);
+                if (r < 0) {
+                    return r;
+                }
+            }
+
+            offset = *data++;
+            run = offset - 1;
+            continue;
+        }
+
+        // Run of data which does not contain 0x00.
+        n = run;
+        if (n > (size_t)(end - data)) {
+            n = (size_t)(end - data);
+        }
+
+        if (memchr(data, 0x00, n)) {
+            return -EILSEQ;
+        }
+
+        r = cobs_iov_add(iov, iovcnt, &count, data, n);
         if (r < 0) {
             return r;
         }
+
+        data += n;
+        run -= (uint8_t)n;
     }
 
-    return cobs_decode_finish(&s, strict);
+    s->offset = offset;
+    s->run = run;
+    return (ssize_t)count;
+}
+
+ssize_t cobs_decode_iov(const uint8_t *data, size_t length, struct iovec *iov, size_t iovcnt, bool strict)
+{
+    struct cobs_decode_state s;
+    ssize_t count;
+    ssize_t r;
+
+    cobs_decode_clear(&s);
+    cobs_decode_start_iov(&s);
+
+    count = cobs_decode_add_iov(&s, data, length, iov, iovcnt);
+    if (count < 0) {
+        return count;
+    }
+
+    r = cobs_decode_finish(&s, strict);
+    if (r < 0) {
+        return r;
+    }
+
+    return count;
 }
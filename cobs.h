@@ -5,6 +5,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /// Get maximum encoded size for data of given length.
 /// @return Number of bytes required to encode data of given length, or 0 on overflow.
@@ -24,6 +25,7 @@ int cobs_encode_clear(struct cobs_encode_state *);
 
 /// Start encoding.
 /// Encode a byte stream so that there are no NUL bytes.
+/// Staged bytes of an unfinished frame are first written to its output.
 /// @return Zero on success, negative errno otherwise.
 int cobs_encode_start(struct cobs_encode_state *, uint8_t *output, size_t capacity);
 
@@ -31,6 +33,28 @@ int cobs_encode_start(struct cobs_encode_state *, uint8_t *output, size_t capaci
 /// @return Zero on success, negative errno otherwise.
 int cobs_encode_add(struct cobs_encode_state *, const uint8_t *data, size_t length);
 
+/// Add @c data, reporting progress.
+/// Variant of cobs_encode_add() for callers which bound the work per call by @c length,
+/// interleaving encoding with other work.
+/// Each byte of @c data is encoded completely or not at all.
+/// @note -ENOSPC ends the frame: the output cannot be extended, but cobs_encode_finish()
+/// completes the encoding of the @c consumed bytes.
+/// @param consumed Set to the number of bytes of @c data consumed, also on error.
+/// @param produced Set to the number of bytes written to @c output, also on error.
+/// In non-temporal mode, these include staged bytes which reach @c output only
+/// when cobs_encode_finish() is called.
+/// @return Zero on success, negative errno otherwise.
+int cobs_encode_add_partial(struct cobs_encode_state *, const uint8_t *data, size_t length, size_t *consumed, size_t *produced);
+
+/// Write output with non-temporal stores, bypassing the cache.
+/// For very large output which is not read back soon, e.g. a DMA buffer.
+/// Output is staged until each cache line, including its offset byte, is complete;
+/// cobs_encode_finish() writes the rest.
+/// May be changed at any time, including between cobs_encode_add() calls.
+/// @note Without SSE2, output is staged but written with ordinary stores.
+/// @return Zero on success, negative errno otherwise.
+int cobs_encode_set_nontemporal(struct cobs_encode_state *, bool enable);
+
 /// Finish encoding.
 /// @return Number of bytes written to @c output, negative errno otherwise.
 ssize_t cobs_encode_finish(struct cobs_encode_state *);
@@ -41,7 +65,6 @@ void cobs_encode_delete(struct cobs_encode_state *);
 
 /// Encode @c data using consistent overhead byte stuffing.
 /// Convenience function.
-/// @note For efficiency, use the lower-level API if encoding large data.
 /// @see cobs_encode_start
 /// @see cobs_encode_add
 /// @see cobs_encode_finish
@@ -49,6 +72,14 @@ void cobs_encode_delete(struct cobs_encode_state *);
 /// @note Memory ownership: Caller retains ownership of all pointers.
 ssize_t cobs_encode(const uint8_t *data, size_t length, uint8_t *output, size_t capacity);
 
+/// Encode @c data, writing @c output with non-temporal stores.
+/// Convenience function, for @c data much larger than the last level cache.
+/// @see cobs_encode
+/// @see cobs_encode_set_nontemporal
+/// @return Number of bytes written to @c output on success, negative errno otherwise.
+/// @note Memory ownership: Caller retains ownership of all pointers.
+ssize_t cobs_encode_nontemporal(const uint8_t *data, size_t length, uint8_t *output, size_t capacity);
+
 /// Models a consistent overhead byte stuffing decoder.
 /// @see https://en.wikipedia.org/wiki/Consistent_Overhead_Byte_Stuffing
 struct cobs_decode_state;
@@ -63,6 +94,7 @@ int cobs_decode_clear(struct cobs_decode_state *);
 
 /// Start decoding.
 /// Decode a byte-stuffed stream.
+/// Staged bytes of an unfinished frame are first written to its output.
 /// @return Zero on success, negative errno otherwise.
 int cobs_decode_start(struct cobs_decode_state *, uint8_t *output, size_t capacity);
 
@@ -71,9 +103,38 @@ int cobs_decode_start(struct cobs_decode_state *, uint8_t *output, size_t capaci
 /// @return Zero on success, negative errno otherwise.
 int cobs_decode_add(struct cobs_decode_state *, const uint8_t *data, size_t length);
 
+/// Add @c data, reporting progress.
+/// Variant of cobs_decode_add() for callers which bound the work per call by @c length,
+/// interleaving decoding with other work.
+/// Each byte of @c data is decoded completely or not at all.
+/// After -ENOSPC, decoding may continue into a new buffer with cobs_decode_resume(),
+/// from @c data + @c consumed.
+/// @note The byte stream may not legally contain a NUL byte.
+/// @param consumed Set to the number of bytes of @c data consumed, also on error.
+/// @param produced Set to the number of bytes written to @c output, also on error.
+/// In non-temporal mode, these include up to one cache line of staged bytes which reach
+/// @c output only when cobs_decode_resume() or cobs_decode_finish() is called.
+/// @return Zero on success, negative errno otherwise.
+int cobs_decode_add_partial(struct cobs_decode_state *, const uint8_t *data, size_t length, size_t *consumed, size_t *produced);
+
+/// Write output with non-temporal stores, bypassing the cache.
+/// For very large output which is not read back soon, e.g. a DMA buffer.
+/// Output is staged a cache line at a time; cobs_decode_finish() writes any partial line.
+/// May be changed at any time, including between cobs_decode_add() calls.
+/// @note Without SSE2, output is staged but written with ordinary stores.
+/// @return Zero on success, negative errno otherwise.
+int cobs_decode_set_nontemporal(struct cobs_decode_state *, bool enable);
+
+/// Continue decoding into a new output buffer.
+/// Unlike cobs_decode_start(), the position within the current run is kept,
+/// so decoding may continue after -ENOSPC.
+/// @return Zero on success, negative errno otherwise.
+int cobs_decode_resume(struct cobs_decode_state *, uint8_t *output, size_t capacity);
+
 /// Finish decoding.
 /// @param strict In strict mode, the final run of non-NUL data bytes must complete.
 /// @return Number of bytes written to @c output, negative errno otherwise.
+/// After cobs_decode_resume(), counts only the bytes written to the new @c output.
 ssize_t cobs_decode_finish(struct cobs_decode_state *, bool strict);
 
 /// Destructor.
@@ -82,7 +143,6 @@ void cobs_decode_delete(struct cobs_decode_state *);
 
 /// Decode byte stuffed @c data.
 /// Convenience function.
-/// @note For efficiency, use the lower-level API if decoding large data.
 /// @see cobs_decode_start
 /// @see cobs_decode_add
 /// @see cobs_decode_finish
@@ -90,4 +150,43 @@ void cobs_decode_delete(struct cobs_decode_state *);
 /// @note Memory ownership: Caller retains ownership of all pointers.
 ssize_t cobs_decode(const uint8_t *data, size_t length, uint8_t *output, size_t capacity, bool strict);
 
+/// Decode byte stuffed @c data, writing @c output with non-temporal stores.
+/// Convenience function, for @c data much larger than the last level cache.
+/// @see cobs_decode
+/// @see cobs_decode_set_nontemporal
+/// @return Number of bytes written to @c output on success, negative errno otherwise.
+/// @note Memory ownership: Caller retains ownership of all pointers.
+ssize_t cobs_decode_nontemporal(const uint8_t *data, size_t length, uint8_t *output, size_t capacity, bool strict);
+
+/// Start zero-copy decoding.
+/// Decode a byte-stuffed stream into segments which reference the input.
+/// Finish with cobs_decode_finish(), which returns zero on success.
+/// @see cobs_decode_add_iov
+/// @return Zero on success, negative errno otherwise.
+int cobs_decode_start_iov(struct cobs_decode_state *);
+
+/// Add @c data without copying.
+/// Fills @c iov with segments which, concatenated, form the data decoded from this chunk.
+/// Runs of non-NUL bytes reference @c data directly; implied NUL bytes are
+/// separate segments which reference a static, read-only buffer of NUL bytes.
+/// Suitable for writev(2).
+/// At most @c length segments are needed.
+/// On error the decoder state is unchanged, so @c data may be added again with a larger @c iov.
+/// @note The byte stream may not legally contain a NUL byte.
+/// @return Number of segments written to @c iov on success, negative errno otherwise.
+/// @note Memory ownership: Caller retains ownership of all pointers.
+/// The segments are valid only while @c data is, and must not be written through.
+ssize_t cobs_decode_add_iov(struct cobs_decode_state *, const uint8_t *data, size_t length, struct iovec *iov, size_t iovcnt);
+
+/// Decode byte stuffed @c data without copying.
+/// Convenience function.
+/// At most @c length segments are needed.
+/// @see cobs_decode_start_iov
+/// @see cobs_decode_add_iov
+/// @see cobs_decode_finish
+/// @return Number of segments written to @c iov on success, negative errno otherwise.
+/// @note Memory ownership: Caller retains ownership of all pointers.
+/// The segments are valid only while @c data is, and must not be written through.
+ssize_t cobs_decode_iov(const uint8_t *data, size_t length, struct iovec *iov, size_t iovcnt, bool strict);
+
 #endif
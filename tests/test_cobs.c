@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 struct test_data
@@ -23,6 +24,31 @@ static struct test_data test_data_make(void)
     return data;
 }
 
+/// Length of the message made by test_data_make_message().
+#define TEST_MESSAGE_LENGTH 600
+
+/// Make a message spanning several blocks, with frequent NUL bytes, and its encoding.
+static struct test_data test_data_make_message(void)
+{
+    struct test_data data = test_data_make();
+    size_t i;
+
+    for (i = 0; i < TEST_MESSAGE_LENGTH; ++i) {
+        data.unencoded[i] = (uint8_t)(i % 7);
+    }
+    data.unencoded_length = TEST_MESSAGE_LENGTH;
+
+    data.encoded_length = cobs_encode(data.unencoded, TEST_MESSAGE_LENGTH, data.encoded, sizeof(data.encoded));
+    assert(data.encoded_length > 0);
+    return data;
+}
+
+/// Length of the chunk at @c offset, when splitting @c length bytes into chunks of at most @c chunk bytes.
+static size_t chunk_length(size_t offset, size_t length, size_t chunk)
+{
+    return length - offset < chunk ? length - offset : chunk;
+}
+
 static void test_cobs_maximum_sizeof(void)
 {
     assert(1 == cobs_maximum_sizeof(0));
@@ -85,6 +111,61 @@ static void test_cobs_encode_api(void)
     cobs_encode_delete(s);
 }
 
+static void test_cobs_encode_add_partial(void)
+{
+    struct cobs_encode_state *s;
+    size_t consumed;
+    size_t produced;
+
+    s = cobs_encode_new();
+
+    {
+        struct test_data data = test_data_make();
+        assert(-EFAULT == cobs_encode_add_partial(NULL, data.unencoded, 1, &consumed, &produced));
+        assert(-EFAULT == cobs_encode_add_partial(s,    NULL,           1, &consumed, &produced));
+        assert(-EFAULT == cobs_encode_add_partial(s,    data.unencoded, 1, NULL,      &produced));
+        assert(-EFAULT == cobs_encode_add_partial(s,    data.unencoded, 1, &consumed, NULL));
+    }
+    {
+        // Work is bounded by length, and continues where it stopped.
+        struct test_data data = test_data_make();
+        struct test_data expected = test_data_make_message();
+        size_t i;
+        size_t total = 0;
+
+        assert(0 == cobs_encode_start(s, data.encoded, sizeof(data.encoded)));
+        for (i = 0; i < TEST_MESSAGE_LENGTH; i += consumed) {
+            assert(0 == cobs_encode_add_partial(s, expected.unencoded + i, chunk_length(i, TEST_MESSAGE_LENGTH, 16), &consumed, &produced));
+            total += produced;
+        }
+        data.encoded_length = cobs_encode_finish(s);
+        assert(data.encoded_length == expected.encoded_length);
+        assert((size_t)data.encoded_length == 1 + total);
+        assert(memcmp(data.encoded, expected.encoded, (size_t)data.encoded_length) == 0);
+    }
+    {
+        // Partially encoded byte is undone.
+        struct test_data data = test_data_make();
+        memset(data.unencoded, 0xaa, 256);
+        assert(0       == cobs_encode_start(s, data.encoded, 255));
+        assert(-ENOSPC == cobs_encode_add_partial(s, data.unencoded, 256, &consumed, &produced));
+        assert(253     == consumed);
+        assert(253     == produced);
+        assert(254     == cobs_encode_finish(s));
+        assert(253     == cobs_decode(data.encoded, 254, data.unencoded, sizeof(data.unencoded), true));
+    }
+    {
+        struct test_data data = test_data_make();
+        uint8_t m[] = { 0x11, 0x00 };
+        assert(0       == cobs_encode_start(s, data.encoded, 2));
+        assert(-ENOSPC == cobs_encode_add_partial(s, m, sizeof(m), &consumed, &produced));
+        assert(1       == consumed);
+        assert(1       == produced);
+    }
+
+    cobs_encode_delete(s);
+}
+
 static void test_cobs_decode(void)
 {
     struct test_data data = test_data_make();
@@ -156,6 +237,219 @@ static void test_cobs_decode_api(void)
     cobs_decode_delete(s);
 }
 
+static void test_cobs_decode_add_partial(void)
+{
+    struct cobs_decode_state *s;
+    size_t consumed;
+    size_t produced;
+
+    s = cobs_decode_new();
+
+    {
+        struct test_data data = test_data_make();
+        assert(-EFAULT == cobs_decode_add_partial(NULL, data.encoded, 1, &consumed, &produced));
+        assert(-EFAULT == cobs_decode_add_partial(s,    NULL,         1, &consumed, &produced));
+        assert(-EFAULT == cobs_decode_add_partial(s,    data.encoded, 1, NULL,      &produced));
+        assert(-EFAULT == cobs_decode_add_partial(s,    data.encoded, 1, &consumed, NULL));
+    }
+    {
+        // Work is bounded by length, and continues where it stopped.
+        struct test_data data = test_data_make();
+        struct test_data expected = test_data_make_message();
+        size_t length = (size_t)expected.encoded_length;
+        size_t i;
+        size_t total = 0;
+
+        assert(0 == cobs_decode_start(s, data.unencoded, sizeof(data.unencoded)));
+        for (i = 0; i < length; i += consumed) {
+            assert(0 == cobs_decode_add_partial(s, expected.encoded + i, chunk_length(i, length, 16), &consumed, &produced));
+            total += produced;
+        }
+        data.unencoded_length = cobs_decode_finish(s, true);
+        assert(data.unencoded_length == TEST_MESSAGE_LENGTH);
+        assert(total == TEST_MESSAGE_LENGTH);
+        assert(memcmp(data.unencoded, expected.unencoded, TEST_MESSAGE_LENGTH) == 0);
+    }
+    {
+        struct test_data data = test_data_make();
+        uint8_t m[] = { 0x02, 0x11, 0x03, 0x22, 0x33 };
+        assert(0       == cobs_decode_start(s, data.unencoded, 2));
+        assert(-ENOSPC == cobs_decode_add_partial(s, m, sizeof(m), &consumed, &produced));
+        assert(3       == consumed);
+        assert(2       == produced);
+        assert(2       == cobs_decode_finish(s, false));
+    }
+    {
+        struct test_data data = test_data_make();
+        uint8_t m[] = { 0x03, 0x11, 0x00 };
+        assert(0       == cobs_decode_start(s, data.unencoded, sizeof(data.unencoded)));
+        assert(-EILSEQ == cobs_decode_add_partial(s, m, sizeof(m), &consumed, &produced));
+        assert(2       == consumed);
+        assert(1       == produced);
+    }
+    {
+        // Resume into a new buffer after -ENOSPC.
+        struct test_data data = test_data_make();
+        struct test_data expected = test_data_make_message();
+        uint8_t first[100];
+
+        assert(0       == cobs_decode_start(s, first, sizeof(first)));
+        assert(-ENOSPC == cobs_decode_add_partial(s, expected.encoded, (size_t)expected.encoded_length, &consumed, &produced));
+        assert(sizeof(first) == produced);
+        assert(sizeof(first) == cobs_decode_finish(s, false));
+
+        assert(-EFAULT == cobs_decode_resume(NULL, data.unencoded, sizeof(data.unencoded)));
+        assert(-EFAULT == cobs_decode_resume(s,    NULL,           sizeof(data.unencoded)));
+        assert(-ENOSPC == cobs_decode_resume(s,    data.unencoded, 0));
+        assert(0       == cobs_decode_resume(s,    data.unencoded, sizeof(data.unencoded)));
+        assert(0       == cobs_decode_add(s, expected.encoded + consumed, (size_t)expected.encoded_length - consumed));
+        assert(TEST_MESSAGE_LENGTH - sizeof(first) == cobs_decode_finish(s, true));
+
+        assert(memcmp(expected.unencoded, first, sizeof(first)) == 0);
+        assert(memcmp(expected.unencoded + sizeof(first), data.unencoded, TEST_MESSAGE_LENGTH - sizeof(first)) == 0);
+    }
+
+    cobs_decode_delete(s);
+}
+
+static void test_cobs_decode_iov(void)
+{
+    struct test_data data = test_data_make();
+    struct iovec iov[4];
+
+    assert(-EFAULT == cobs_decode_iov(NULL,         0, iov,  4, false));
+    assert(-EFAULT == cobs_decode_iov(data.encoded, 0, NULL, 4, false));
+    assert(0       == cobs_decode_iov(data.encoded, 0, iov,  0, false));
+
+    {
+        uint8_t m[] = { 0x00 };
+        assert(-EILSEQ == cobs_decode_iov(m, sizeof(m), iov, 4, false));
+    }
+    {
+        uint8_t m[] = { 0x03, 0x11, 0x00 };
+        assert(-EILSEQ == cobs_decode_iov(m, sizeof(m), iov, 4, false));
+    }
+    {
+        uint8_t m[] = { 0x02, 0x11 };
+        assert(-ENOSPC == cobs_decode_iov(m, sizeof(m), iov, 0, false));
+        assert(1       == cobs_decode_iov(m, sizeof(m), iov, 1, false));
+        assert(iov[0].iov_base == &m[1]);
+        assert(iov[0].iov_len  == 1);
+    }
+    {
+        uint8_t m[] = { 0x02, 0x11, 0x02, 0x22 };
+        assert(-ENOSPC == cobs_decode_iov(m, sizeof(m), iov, 1, false));
+        assert(-ENOSPC == cobs_decode_iov(m, sizeof(m), iov, 2, false));
+        assert(3       == cobs_decode_iov(m, sizeof(m), iov, 3, false));
+        assert(iov[0].iov_base == &m[1]);
+        assert(iov[1].iov_len  == 1);
+        assert(*(const uint8_t *)iov[1].iov_base == 0x00);
+        assert(iov[2].iov_base == &m[3]);
+    }
+    {
+        uint8_t m[] = { 0x04, 0x11, 0x22 };
+        assert(-EMSGSIZE == cobs_decode_iov(m, sizeof(m), iov, 4, true));
+        assert(1         == cobs_decode_iov(m, sizeof(m), iov, 4, false));
+        assert(iov[0].iov_len == 2);
+    }
+    {
+        struct cobs_decode_state *s = cobs_decode_new();
+        uint8_t m[] = { 0x02, 0x11, 0x02, 0x22 };
+
+        assert(-EFAULT == cobs_decode_start_iov(NULL));
+        assert(0       == cobs_decode_start_iov(s));
+        assert(-EFAULT == cobs_decode_add_iov(NULL, m,    sizeof(m), iov,  4));
+        assert(-EFAULT == cobs_decode_add_iov(s,    NULL, sizeof(m), iov,  4));
+        assert(-EFAULT == cobs_decode_add_iov(s,    m,    sizeof(m), NULL, 4));
+
+        // State is unchanged on error, so the chunk may be added again.
+        assert(0       == cobs_decode_add_iov(s, m, 1, iov, 4));
+        assert(-ENOSPC == cobs_decode_add_iov(s, m + 1, 3, iov, 2));
+        assert(3       == cobs_decode_add_iov(s, m + 1, 3, iov, 3));
+        assert(iov[0].iov_base == &m[1]);
+        assert(*(const uint8_t *)iov[1].iov_base == 0x00);
+        assert(iov[2].iov_base == &m[3]);
+        assert(0       == cobs_decode_finish(s, true));
+
+        cobs_decode_delete(s);
+    }
+}
+
+/// Decode @c data with cobs_decode_iov(), and in chunks with cobs_decode_add_iov(),
+/// and check both against cobs_decode().
+/// @return Number of segments from cobs_decode_iov().
+static ssize_t check_decode_iov(const uint8_t *data, size_t length)
+{
+    struct test_data expected = test_data_make();
+    struct test_data actual = test_data_make();
+    struct cobs_decode_state *s;
+    struct iovec iov[64];
+    ssize_t count;
+    ssize_t chunk;
+    ssize_t i;
+    size_t j;
+    size_t n;
+
+    expected.unencoded_length = cobs_decode(data, length, expected.unencoded, sizeof(expected.unencoded), false);
+    assert(expected.unencoded_length >= 0);
+
+    count = cobs_decode_iov(data, length, iov, sizeof(iov) / sizeof(iov[0]), false);
+    assert(count >= 0);
+
+    for (i = 0; i < count; ++i) {
+        memcpy(actual.unencoded + actual.unencoded_length, iov[i].iov_base, iov[i].iov_len);
+        actual.unencoded_length += (ssize_t)iov[i].iov_len;
+    }
+
+    assert(actual.unencoded_length == expected.unencoded_length);
+    assert(memcmp(actual.unencoded, expected.unencoded, (size_t)actual.unencoded_length) == 0);
+    assert((size_t)count <= length);
+
+    actual = test_data_make();
+    s = cobs_decode_new();
+    assert(0 == cobs_decode_start_iov(s));
+
+    for (j = 0; j < length; j += n) {
+        n = chunk_length(j, length, 5);
+        chunk = cobs_decode_add_iov(s, data + j, n, iov, n);
+        assert(chunk >= 0);
+
+        for (i = 0; i < chunk; ++i) {
+            memcpy(actual.unencoded + actual.unencoded_length, iov[i].iov_base, iov[i].iov_len);
+            actual.unencoded_length += (ssize_t)iov[i].iov_len;
+        }
+    }
+
+    assert(0 == cobs_decode_finish(s, false));
+    cobs_decode_delete(s);
+
+    assert(actual.unencoded_length == expected.unencoded_length);
+    assert(memcmp(actual.unencoded, expected.unencoded, (size_t)actual.unencoded_length) == 0);
+    return count;
+}
+
+static void test_roundtrip_iov(void)
+{
+    struct test_data data = test_data_make();
+    uint8_t m[600];
+
+    // Long runs of non-NUL bytes, interspersed with NUL.
+    memset(m, 0xaa, sizeof(m));
+    m[0] = 0x00;
+    m[300] = 0x00;
+    m[301] = 0x00;
+    m[599] = 0x00;
+    data.encoded_length = cobs_encode(m, sizeof(m), data.encoded, sizeof(data.encoded));
+    assert(data.encoded_length > 0);
+    assert(7 == check_decode_iov(data.encoded, (size_t)data.encoded_length));
+
+    // Consecutive NUL bytes are merged, up to the size of the NUL buffer.
+    memset(m, 0x00, sizeof(m));
+    data.encoded_length = cobs_encode(m, sizeof(m), data.encoded, sizeof(data.encoded));
+    assert(data.encoded_length == sizeof(m) + 1);
+    assert(3 == check_decode_iov(data.encoded, (size_t)data.encoded_length));
+}
+
 static void test_roundtrip_empty(void)
 {
     struct test_data data = test_data_make();
@@ -291,13 +585,258 @@ static void test_roundtrip_255(void)
     assert(memcmp(m, data.unencoded, sizeof(m)) == 0);
 }
 
+static void test_cobs_decode_nontemporal(void)
+{
+    struct cobs_decode_state *s;
+    struct test_data data = test_data_make();
+    struct test_data expected = test_data_make_message();
+    // Cache line aligned output.
+    uint8_t *output = (uint8_t *)(((uintptr_t)data.unencoded + 63) & ~(uintptr_t)63);
+    const uint8_t *m = expected.unencoded;
+    size_t length = (size_t)expected.encoded_length;
+    size_t consumed;
+    size_t produced;
+    size_t i;
+
+    s = cobs_decode_new();
+
+    assert(-EFAULT == cobs_decode_set_nontemporal(NULL, true));
+    assert(0       == cobs_decode_set_nontemporal(s,    true));
+
+    {
+        // Small chunks, into unaligned output.
+        memset(data.unencoded, 0xca, sizeof(data.unencoded));
+        assert(0 == cobs_decode_start(s, output + 3, TEST_MESSAGE_LENGTH));
+        for (i = 0; i < length; i += 7) {
+            assert(0 == cobs_decode_add(s, expected.encoded + i, chunk_length(i, length, 7)));
+        }
+        assert(TEST_MESSAGE_LENGTH == cobs_decode_finish(s, true));
+        assert(memcmp(m, output + 3, TEST_MESSAGE_LENGTH) == 0);
+    }
+    {
+        // Output ends part way through a line; resume writes the staged bytes.
+        memset(data.unencoded, 0xca, sizeof(data.unencoded));
+        assert(0       == cobs_decode_start(s, output, 100));
+        assert(-ENOSPC == cobs_decode_add_partial(s, expected.encoded, length, &consumed, &produced));
+        assert(100     == produced);
+        assert(0       == cobs_decode_resume(s, output + 128, TEST_MESSAGE_LENGTH - 100));
+        assert(0       == cobs_decode_add(s, expected.encoded + consumed, length - consumed));
+        assert(TEST_MESSAGE_LENGTH - 100 == cobs_decode_finish(s, true));
+        assert(memcmp(m, output, 100) == 0);
+        assert(memcmp(m + 100, output + 128, TEST_MESSAGE_LENGTH - 100) == 0);
+    }
+    {
+        // Produced bytes are staged until finished.
+        size_t total = 0;
+        memset(data.unencoded, 0xca, sizeof(data.unencoded));
+        assert(0 == cobs_decode_start(s, output, TEST_MESSAGE_LENGTH));
+        for (i = 0; i < 100; i += consumed) {
+            assert(0 == cobs_decode_add_partial(s, expected.encoded + i, chunk_length(i, 100, 16), &consumed, &produced));
+            total += produced;
+        }
+        assert(0 < total % 64);
+        assert(0xca == output[total - 1]);
+        assert(0 == cobs_decode_add(s, expected.encoded + 100, length - 100));
+        assert(TEST_MESSAGE_LENGTH == cobs_decode_finish(s, true));
+        assert(memcmp(m, output, TEST_MESSAGE_LENGTH) == 0);
+    }
+    {
+        // Starting again writes the staged bytes of the abandoned frame.
+        memset(data.unencoded, 0xca, sizeof(data.unencoded));
+        assert(0 == cobs_decode_start(s, output, TEST_MESSAGE_LENGTH));
+        assert(0 == cobs_decode_add(s, expected.encoded, 100));
+        assert(0 == cobs_decode_start(s, output + 256, TEST_MESSAGE_LENGTH));
+        assert(memcmp(m, output, 80) == 0);
+    }
+    {
+        // Disabling part way through a frame writes the staged bytes.
+        memset(data.unencoded, 0xca, sizeof(data.unencoded));
+        assert(0 == cobs_decode_start(s, output, TEST_MESSAGE_LENGTH));
+        assert(0 == cobs_decode_add(s, expected.encoded, 100));
+        assert(0 == cobs_decode_set_nontemporal(s, false));
+        assert(0 == cobs_decode_add(s, expected.encoded + 100, length - 100));
+        assert(TEST_MESSAGE_LENGTH == cobs_decode_finish(s, true));
+        assert(memcmp(m, output, TEST_MESSAGE_LENGTH) == 0);
+    }
+
+    cobs_decode_delete(s);
+}
+
+/// Encode @c m with non-temporal stores, in chunks, into output at @c misalign bytes
+/// past a cache line boundary, and check it against cobs_encode().
+static void check_encode_nontemporal(const uint8_t *m, size_t length, size_t chunk, size_t misalign)
+{
+    struct cobs_encode_state *s = cobs_encode_new();
+    struct test_data expected = test_data_make();
+    struct test_data data = test_data_make();
+    uint8_t *output = (uint8_t *)(((uintptr_t)data.encoded + 63) & ~(uintptr_t)63) + misalign;
+    size_t consumed;
+    size_t produced;
+    size_t total = 0;
+    size_t i;
+
+    expected.encoded_length = cobs_encode(m, length, expected.encoded, sizeof(expected.encoded));
+    assert(expected.encoded_length > 0);
+
+    assert(0 == cobs_encode_set_nontemporal(s, true));
+    assert(0 == cobs_encode_start(s, output, sizeof(data.encoded) - 128));
+    for (i = 0; i < length; i += consumed) {
+        assert(0 == cobs_encode_add_partial(s, m + i, chunk_length(i, length, chunk), &consumed, &produced));
+        total += produced;
+    }
+    assert(expected.encoded_length == cobs_encode_finish(s));
+    assert((size_t)expected.encoded_length == 1 + total);
+    assert(memcmp(output, expected.encoded, (size_t)expected.encoded_length) == 0);
+
+    cobs_encode_delete(s);
+}
+
+static void test_cobs_encode_nontemporal(void)
+{
+    struct cobs_encode_state *s;
+    struct test_data message = test_data_make_message();
+    struct test_data data = test_data_make();
+    struct test_data expected = test_data_make();
+    // Cache line aligned output.
+    uint8_t *output = (uint8_t *)(((uintptr_t)data.encoded + 63) & ~(uintptr_t)63);
+    uint8_t runs[TEST_MESSAGE_LENGTH];
+    size_t consumed;
+    size_t produced;
+    size_t i;
+
+    assert(-EFAULT == cobs_encode_set_nontemporal(NULL, true));
+
+    // Runs longer than a block hold the pending offset byte across several lines.
+    for (i = 0; i < sizeof(runs); ++i) {
+        runs[i] = (i % 300) ? (uint8_t)(i | 1) : 0x00;
+    }
+
+    for (i = 0; i < 64; i += 9) {
+        check_encode_nontemporal(message.unencoded, TEST_MESSAGE_LENGTH, 7, i);
+        check_encode_nontemporal(message.unencoded, TEST_MESSAGE_LENGTH, TEST_MESSAGE_LENGTH, i);
+        check_encode_nontemporal(runs, sizeof(runs), 5, i);
+        check_encode_nontemporal(runs, sizeof(runs), sizeof(runs), i);
+    }
+
+    s = cobs_encode_new();
+    assert(0 == cobs_encode_set_nontemporal(s, true));
+
+    expected.encoded_length = cobs_encode(runs, sizeof(runs), expected.encoded, sizeof(expected.encoded));
+    assert(expected.encoded_length > 0);
+
+    {
+        // Produced bytes are staged until finished.
+        memset(data.encoded, 0xca, sizeof(data.encoded));
+        assert(0 == cobs_encode_start(s, output, sizeof(data.encoded) - 64));
+        assert(0 == cobs_encode_add_partial(s, runs, 100, &consumed, &produced));
+        assert(100 == consumed);
+        assert(100 == produced);
+        assert(0xca == output[100]);
+        assert(101 == cobs_encode_finish(s));
+        assert(memcmp(output + 2, runs + 1, 99) == 0);
+    }
+    {
+        // Disabling part way through a frame writes the staged bytes.
+        memset(data.encoded, 0xca, sizeof(data.encoded));
+        assert(0 == cobs_encode_start(s, output, sizeof(data.encoded) - 64));
+        assert(0 == cobs_encode_add(s, runs, 100));
+        assert(0 == cobs_encode_set_nontemporal(s, false));
+        assert(0 == cobs_encode_add(s, runs + 100, sizeof(runs) - 100));
+        assert(expected.encoded_length == cobs_encode_finish(s));
+        assert(memcmp(output, expected.encoded, (size_t)expected.encoded_length) == 0);
+        assert(0 == cobs_encode_set_nontemporal(s, true));
+    }
+    {
+        // Starting again writes the staged bytes of the abandoned frame.
+        memset(data.encoded, 0xca, sizeof(data.encoded));
+        assert(0 == cobs_encode_start(s, output, sizeof(data.encoded) - 64));
+        assert(0 == cobs_encode_add(s, runs, 100));
+        assert(0 == cobs_encode_start(s, output + 256, sizeof(data.encoded) - 64 - 256));
+        assert(memcmp(output + 2, runs + 1, 99) == 0);
+    }
+    {
+        // Output ends part way through a line.
+        memset(data.encoded, 0xca, sizeof(data.encoded));
+        assert(0       == cobs_encode_start(s, output, 100));
+        assert(-ENOSPC == cobs_encode_add_partial(s, runs, sizeof(runs), &consumed, &produced));
+        assert(99      == consumed);
+        assert(99      == produced);
+        assert(100     == cobs_encode_finish(s));
+        assert(0x01    == output[0]);
+        assert(99      == output[1]);
+        assert(memcmp(output + 2, runs + 1, 98) == 0);
+    }
+    {
+        // Output ends as a block completes; the partially encoded byte is undone.
+        memset(data.unencoded, 0xaa, 256);
+        assert(0       == cobs_encode_start(s, output, 255));
+        assert(-ENOSPC == cobs_encode_add_partial(s, data.unencoded, 256, &consumed, &produced));
+        assert(253     == consumed);
+        assert(253     == produced);
+        assert(254     == cobs_encode_finish(s));
+    }
+
+    cobs_encode_delete(s);
+}
+
+static void test_roundtrip_nontemporal(void)
+{
+    size_t length = 64 * 1024;
+    size_t capacity = cobs_maximum_sizeof(length);
+    uint8_t *m = malloc(length);
+    uint8_t *expected = malloc(capacity);
+    uint8_t *encoded = malloc(capacity);
+    uint8_t *unencoded = malloc(length);
+    ssize_t encoded_length;
+    size_t i;
+
+    assert(m && expected && encoded && unencoded);
+
+    for (i = 0; i < length; ++i) {
+        m[i] = (uint8_t)(i % 251);
+    }
+
+    encoded_length = cobs_encode(m, length, expected, capacity);
+    assert(encoded_length > 0);
+
+    assert(-EFAULT == cobs_encode_nontemporal(NULL, length, encoded, capacity));
+    assert(-ENOSPC == cobs_encode_nontemporal(m,    length, encoded, 1));
+    assert(encoded_length == cobs_encode_nontemporal(m, length, encoded, capacity));
+    assert(memcmp(expected, encoded, (size_t)encoded_length) == 0);
+
+    assert(-EFAULT == cobs_decode_nontemporal(NULL,    (size_t)encoded_length, unencoded, length, true));
+    assert(-ENOSPC == cobs_decode_nontemporal(encoded, (size_t)encoded_length, unencoded, 0,      true));
+    assert(length  == (size_t)cobs_decode_nontemporal(encoded, (size_t)encoded_length, unencoded, length, true));
+    assert(memcmp(m, unencoded, length) == 0);
+
+    // On error, output written so far is not lost.
+    memset(encoded, 0xca, capacity);
+    assert(-ENOSPC == cobs_encode_nontemporal(m, length, encoded, length / 2 + 1));
+    // Bytes before the pending block are final.
+    assert(memcmp(expected, encoded, length / 2 - 255) == 0);
+
+    memset(unencoded, 0xca, length);
+    assert(-ENOSPC == cobs_decode_nontemporal(expected, (size_t)encoded_length, unencoded, length / 2 + 1, true));
+    assert(memcmp(m, unencoded, length / 2 + 1) == 0);
+
+    free(unencoded);
+    free(encoded);
+    free(expected);
+    free(m);
+}
+
 int main(void)
 {
     test_cobs_maximum_sizeof();
     test_cobs_encode();
     test_cobs_encode_api();
+    test_cobs_encode_add_partial();
+    test_cobs_encode_nontemporal();
     test_cobs_decode();
     test_cobs_decode_api();
+    test_cobs_decode_add_partial();
+    test_cobs_decode_nontemporal();
+    test_cobs_decode_iov();
     test_roundtrip_empty();
     test_roundtrip_no_zeroes();
     test_roundtrip_starting_with_zero(true);
@@ -306,4 +845,6 @@ int main(void)
     test_roundtrip_253();
     test_roundtrip_254();
     test_roundtrip_255();
+    test_roundtrip_iov();
+    test_roundtrip_nontemporal();
 }